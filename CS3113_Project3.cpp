@@ -4,6 +4,8 @@
 #include <vector>
 #include <tuple>
 #include <algorithm>
+#include <utility>
+#include <string>
 
 using namespace std;
 
@@ -86,6 +88,9 @@ bool operator==(const MemoryBlock &a, const MemoryBlock &b) {
         && a.size         == b.size;
 }
 
+// Granularity (in words) of dirty-region tracking for memory snapshots.
+const int SNAPSHOT_PAGE_SIZE = 16;
+
 class MemoryManager {
 public:
     MemoryManager(int maxMem)
@@ -96,6 +101,10 @@ public:
             mainMemory[i] = -1;
         }
         memList.push_back({-1, 0, maxMemory});
+        // every page starts dirty so the first snapshot is a full base image
+        int numPages = (maxMemory + SNAPSHOT_PAGE_SIZE - 1) / SNAPSHOT_PAGE_SIZE;
+        pageDirty.resize(numPages, false);
+        markDirty(0, maxMemory);
     }
     ~MemoryManager() {
         delete[] mainMemory;
@@ -107,6 +116,71 @@ public:
             cout << i << " : " << mainMemory[i] << endl;
         }
     }
+
+    // Record that words [start, start + count) of mainMemory were modified.
+    // Anyone writing through getMainMemory() must call this.
+    void markDirty(int start, int count) {
+        if (count <= 0) return;
+        int firstPage = start / SNAPSHOT_PAGE_SIZE;
+        int lastPage = (start + count - 1) / SNAPSHOT_PAGE_SIZE;
+        for (int page = firstPage; page <= lastPage; page++) {
+            if (!pageDirty[page]) {
+                pageDirty[page] = true;
+                dirtyPages.push_back(page);
+            }
+        }
+    }
+
+    // Write the pages changed since the last snapshot as a delta:
+    //   DELTA <numRegions>
+    //   <startAddress> <length> <word> <word> ...   (one line per region)
+    // Adjacent dirty pages are merged into one region. Cost is proportional
+    // to the number of dirty words, not maxMemory.
+    void writeSnapshotDelta(ostream &out) {
+        sort(dirtyPages.begin(), dirtyPages.end());
+        vector<pair<int, int>> regions; // (startAddress, length)
+        for (int page : dirtyPages) {
+            int start = page * SNAPSHOT_PAGE_SIZE;
+            int length = min(SNAPSHOT_PAGE_SIZE, maxMemory - start);
+            if (!regions.empty()
+                && regions.back().first + regions.back().second == start) {
+                regions.back().second += length;
+            } else {
+                regions.push_back({start, length});
+            }
+            pageDirty[page] = false;
+        }
+        dirtyPages.clear();
+
+        out << "DELTA " << regions.size() << "\n";
+        for (const auto &region : regions) {
+            out << region.first << " " << region.second;
+            for (int addr = region.first; addr < region.first + region.second; addr++) {
+                out << " " << mainMemory[addr];
+            }
+            out << "\n";
+        }
+    }
+
+    // Replay one delta written by writeSnapshotDelta on top of image.
+    // Returns false if the stream holds no well-formed delta.
+    static bool applySnapshotDelta(istream &in, vector<int> &image) {
+        string tag;
+        int numRegions;
+        if (!(in >> tag >> numRegions) || tag != "DELTA") return false;
+        for (int r = 0; r < numRegions; r++) {
+            int start, length;
+            if (!(in >> start >> length)) return false;
+            if (start < 0 || length < 0) return false;
+            if ((int)image.size() < start + length) {
+                image.resize(start + length, -1);
+            }
+            for (int addr = start; addr < start + length; addr++) {
+                if (!(in >> image[addr])) return false;
+            }
+        }
+        return true;
+    }
     
     void loadJobs(queue<PCB> &newJobQueue, queue<ReadyItem> &readyQueue) {
         bool loadedSomething = true;
@@ -168,6 +242,7 @@ public:
                 for (int addr = start; addr < start + blk.size; addr++) {
                     mainMemory[addr] = -1;
                 }
+                markDirty(start, blk.size);
                 cout << "Process " << pid 
                      << " terminated and released memory from "
                      << start << " to " << end << "." << endl;
@@ -191,6 +266,8 @@ private:
     int maxMemory;
     int* mainMemory;
     list<MemoryBlock> memList;
+    vector<bool> pageDirty;  // per-page flag, set until the next snapshot
+    vector<int> dirtyPages;  // indices of pages with pageDirty set
     
     list<MemoryBlock>::iterator findFirstFit(int neededSize) {
         for (auto it = memList.begin(); it != memList.end(); ++it) {
@@ -259,6 +336,7 @@ private:
         for (int i = 0; i < (int)job.logicalMemory.size() - 1; i++) {
             mainMemory[start + 10 + i] = job.logicalMemory[i];
         }
+        markDirty(start, 10 + (int)job.logicalMemory.size() - 1);
     }
 };
 class CPU {
@@ -288,6 +366,9 @@ public:
         int maxMemNeed = mainMemory[startAddress + 8];
         int mmBase = mainMemory[startAddress + 9];
         
+        // every write below lands in the 10-word PCB header
+        memManager.markDirty(startAddress, 10);
+
         if (pc == 0) {
             pc = instrBase;
         }
@@ -541,6 +622,7 @@ int main() {
                 if (currentTime >= req.exitTime) {
                     int pid = memManager.getMainMemory()[req.startAddress + 0];
                     memManager.getMainMemory()[req.startAddress + 1] = 1;
+                    memManager.markDirty(req.startAddress + 1, 1);
                     readyQueue.push({req.startAddress, req.dataPointer});
                     cout << "print" << endl;
                     cout << "Process " << pid